@@ -0,0 +1,795 @@
+/* dv_convergence.cc
+   Distance-vector (RIP) convergence benchmark on generated router meshes (ns-3)
+
+   Builds a grid or random mesh, routes it with RipHelper (distance vector,
+   as in vecctor_routing.pkt) or Ipv4GlobalRoutingHelper (link state), and
+   runs a Go-Back-N flow between two far-apart routers. Once the tables have
+   settled, the flow's route is followed router by router and links on it
+   are taken down (never cutting the flow off). The scenario reports:
+
+     diameter     - longest shortest path in the mesh, in hops
+     hops         - length of the flow's route when the failure hits
+     initConvS    - time until every router first has a stable route to every
+                    probed destination it can reach
+     reconvS      - time from the failure until the last routing change
+     routeChanges - probed (router, destination) lookups that changed after it
+     ctrlPkts     - RIP messages sent in total / from the failure up to the
+                    last routing change
+     dataDrops    - flow packets lost during reconvergence, in the network or
+                    refused at the source for lack of a route
+     outageS      - longest gap between in-order deliveries after the failure
+     timeouts     - Go-Back-N timeouts after the failure
+
+   RIP's metric tops out at 15 hops, so on meshes with a diameter above 14
+   some router pairs can never reach each other under RIP. The flow (for
+   both protocols) runs to the farthest router within 12 hops of router 0,
+   failures are chosen so it stays within 14, and convergence under
+   RIP only waits for lookups that are within it. Compare the diameter
+   column before reading a slow RIP result as a scaling problem.
+
+   Routing state is sampled every probeInterval by looking up a handful of
+   destinations from every router, so convergence is resolved to that step.
+   A run counts as converged once every reachable lookup has a route and
+   nothing changed for settleTime, which under RIP is stretched to 1.5 x
+   ripUpdate so a whole round of periodic updates fits in it. The probe's
+   own cost is reported as probeWallMs and left out of wallMs.
+   Global routing recomputes synchronously on the interface event and sends
+   no control traffic; for it the interesting number is the wall time the
+   recomputation takes (recomputeWallMs).
+
+   Compile: put it and mesh_topology.h in ns-3/scratch/ and run, e.g.
+     ./ns3 run "scratch/dv_convergence --routing=rip --topology=grid --nRouters=49"
+     ./ns3 run "scratch/dv_convergence --sweep=true --sizeList=9,25,100,400"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/seq-ts-header.h"
+
+#include "mesh_topology.h"
+
+#include <chrono>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+NS_LOG_COMPONENT_DEFINE("DvConvergenceExample");
+
+static const uint16_t DATA_PORT = 8080;
+static const uint16_t ACK_PORT = 8081;
+static const uint16_t RIP_PORT = 520;
+
+// ---------------------- Statistics ----------------------
+struct DvStats {
+  Time failTime = Time::Max();
+  uint32_t ctrlPackets = 0;
+  uint64_t ctrlBytes = 0;
+  uint32_t ctrlPacketsReconv = 0;
+  uint32_t dataDrops = 0;
+  uint32_t timeouts = 0;
+  uint32_t delivered = 0;
+  Time lastDelivery;
+  Time maxOutage;
+};
+
+// ---------------------- Go-Back-N Sender ----------------------
+class GoBackNSender : public Application {
+public:
+  GoBackNSender();
+  void Setup(Ptr<Socket> socket, Address peer, uint32_t totalPackets, Time timeout,
+             uint32_t windowSize, DvStats *stats);
+
+private:
+  virtual void StartApplication();
+  virtual void StopApplication();
+  void SendWindow();
+  void Timeout();
+  void HandleAck(Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;
+  Address m_peer;
+  uint32_t m_totalPackets;
+  uint32_t m_windowSize;
+  Time m_timeout;
+  uint32_t m_base;
+  uint32_t m_nextSeq;
+  EventId m_timeoutEvent;
+  DvStats *m_stats;
+};
+
+GoBackNSender::GoBackNSender()
+    : m_socket(0), m_totalPackets(0), m_windowSize(0), m_base(0), m_nextSeq(0), m_stats(0) {}
+
+void GoBackNSender::Setup(Ptr<Socket> socket, Address peer, uint32_t totalPackets, Time timeout,
+                          uint32_t windowSize, DvStats *stats) {
+  m_socket = socket;
+  m_peer = peer;
+  m_totalPackets = totalPackets;
+  m_timeout = timeout;
+  m_windowSize = windowSize;
+  m_stats = stats;
+}
+
+void GoBackNSender::StartApplication() {
+  m_socket->Connect(m_peer);
+  m_socket->SetRecvCallback(MakeCallback(&GoBackNSender::HandleAck, this));
+  SendWindow();
+}
+
+void GoBackNSender::StopApplication() {
+  Simulator::Cancel(m_timeoutEvent);
+  if (m_socket)
+    m_socket->Close();
+}
+
+void GoBackNSender::SendWindow() {
+  while (m_nextSeq < m_base + m_windowSize && m_nextSeq < m_totalPackets) {
+    Ptr<Packet> pkt = Create<Packet>(100);
+    SeqTsHeader hdr;
+    hdr.SetSeq(m_nextSeq);
+    pkt->AddHeader(hdr);
+    // With no route at the source Send() fails before the Ipv4 Drop trace
+    // would see the packet, so those losses are counted here. Before the
+    // failure it only means the mesh has not converged yet.
+    if (m_socket->Send(pkt) < 0 && Simulator::Now() >= m_stats->failTime)
+      m_stats->dataDrops++;
+    NS_LOG_INFO("Sender: Sent packet " << m_nextSeq);
+    m_nextSeq++;
+  }
+  if (!m_timeoutEvent.IsRunning())
+    m_timeoutEvent = Simulator::Schedule(m_timeout, &GoBackNSender::Timeout, this);
+}
+
+void GoBackNSender::Timeout() {
+  NS_LOG_INFO("Timeout! Resending window from " << m_base);
+  if (Simulator::Now() >= m_stats->failTime)
+    m_stats->timeouts++;
+  m_nextSeq = m_base;
+  SendWindow();
+}
+
+void GoBackNSender::HandleAck(Ptr<Socket> socket) {
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv())) {
+    SeqTsHeader hdr;
+    packet->RemoveHeader(hdr);
+    uint32_t ack = hdr.GetSeq();
+    NS_LOG_INFO("Sender: Got ACK " << ack);
+
+    if (ack + 1 > m_base) {
+      m_base = ack + 1;
+      if (m_nextSeq < m_base)
+        m_nextSeq = m_base;
+      Simulator::Cancel(m_timeoutEvent);
+      if (m_base != m_nextSeq)
+        m_timeoutEvent = Simulator::Schedule(m_timeout, &GoBackNSender::Timeout, this);
+    }
+  }
+
+  if (m_base < m_totalPackets)
+    SendWindow();
+}
+
+// ---------------------- Go-Back-N Receiver ----------------------
+class GoBackNReceiver : public Application {
+public:
+  GoBackNReceiver();
+  void Setup(Ptr<Socket> socket, DvStats *stats);
+
+private:
+  virtual void StartApplication();
+  virtual void StopApplication();
+  void HandleRead(Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;
+  uint32_t m_expected;
+  DvStats *m_stats;
+};
+
+GoBackNReceiver::GoBackNReceiver() : m_socket(0), m_expected(0), m_stats(0) {}
+
+void GoBackNReceiver::Setup(Ptr<Socket> socket, DvStats *stats) {
+  m_socket = socket;
+  m_stats = stats;
+}
+
+void GoBackNReceiver::StartApplication() {
+  m_socket->SetRecvCallback(MakeCallback(&GoBackNReceiver::HandleRead, this));
+}
+
+void GoBackNReceiver::StopApplication() {
+  if (m_socket)
+    m_socket->Close();
+}
+
+void GoBackNReceiver::HandleRead(Ptr<Socket> socket) {
+  Ptr<Packet> pkt;
+  while ((pkt = socket->Recv())) {
+    SeqTsHeader hdr;
+    pkt->RemoveHeader(hdr);
+    uint32_t seq = hdr.GetSeq();
+
+    if (seq == m_expected) {
+      NS_LOG_INFO("Receiver: Got packet " << seq);
+      m_expected++;
+      Time now = Simulator::Now();
+      if (now > m_stats->failTime)
+        m_stats->maxOutage = std::max(m_stats->maxOutage,
+                                      now - std::max(m_stats->lastDelivery, m_stats->failTime));
+      m_stats->lastDelivery = now;
+      m_stats->delivered++;
+    } else {
+      NS_LOG_INFO("Receiver: Got out-of-order packet " << seq << " (expected " << m_expected
+                                                       << ")");
+    }
+
+    // Send ACK for last correctly received
+    Ptr<Packet> ack = Create<Packet>();
+    SeqTsHeader ackHdr;
+    ackHdr.SetSeq(m_expected - 1);
+    ack->AddHeader(ackHdr);
+    socket->Send(ack);
+  }
+}
+
+// ---------------------- Topology ----------------------
+// RIP treats metric 16 as unreachable, and a destination /30 costs at least
+// one more than the hops to its nearer end, so only networks this close are
+// guaranteed to be reachable under RIP.
+static const uint32_t RIP_MAX_HOPS = 14;
+
+// Offset keeping the probe-target stream apart from the mesh builder's
+static const int64_t TARGET_STREAM_OFFSET = 1 << 20;
+
+struct ProbeTarget {
+  Ipv4Address address;
+  uint32_t link;
+};
+
+static uint32_t Diameter(const MeshTopology &topo) {
+  uint32_t diameter = 0;
+  std::vector<uint32_t> dist;
+  for (uint32_t n = 0; n < topo.nRouters; ++n) {
+    MeshBfs(topo, n, {}, dist);
+    for (uint32_t d : dist)
+      if (d != UINT32_MAX)
+        diameter = std::max(diameter, d);
+  }
+  return diameter;
+}
+
+// Which (router, target) lookups should succeed once routing has settled with
+// the links in `down` gone, in the probe's router-major order
+static std::vector<bool> ExpectedRoutes(const MeshTopology &topo,
+                                        const std::vector<ProbeTarget> &targets,
+                                        const std::set<uint32_t> &down, uint32_t maxHops) {
+  std::vector<bool> expected(topo.nRouters * targets.size(), false);
+  for (uint32_t t = 0; t < targets.size(); ++t) {
+    if (down.count(targets[t].link))
+      continue;
+    std::vector<uint32_t> distA, distB;
+    MeshBfs(topo, topo.links[targets[t].link].first, down, distA);
+    MeshBfs(topo, topo.links[targets[t].link].second, down, distB);
+    for (uint32_t n = 0; n < topo.nRouters; ++n)
+      expected[n * targets.size() + t] = std::min(distA[n], distB[n]) <= maxHops;
+  }
+  return expected;
+}
+
+// Links on the flow's route, taken from the middle outwards, that can all
+// fail together while dst stays within maxHops of src. Links in `keep`
+// carry the flow's own addresses and are never picked.
+static std::set<uint32_t> PickFailures(const MeshTopology &topo,
+                                       const std::vector<uint32_t> &pathLinks, uint32_t src,
+                                       uint32_t dst, uint32_t nFailures,
+                                       const std::set<uint32_t> &keep, uint32_t maxHops) {
+  std::vector<uint32_t> order;
+  int32_t mid = pathLinks.size() / 2;
+  for (int32_t off = 0; order.size() < pathLinks.size(); ++off) {
+    if (mid + off < static_cast<int32_t>(pathLinks.size()))
+      order.push_back(pathLinks[mid + off]);
+    if (off > 0 && mid - off >= 0)
+      order.push_back(pathLinks[mid - off]);
+  }
+
+  std::set<uint32_t> down;
+  std::vector<uint32_t> dist;
+  for (uint32_t l : order) {
+    if (down.size() >= nFailures)
+      break;
+    if (keep.count(l))
+      continue;
+    down.insert(l);
+    MeshBfs(topo, src, down, dist);
+    if (dist[dst] > maxHops)
+      down.erase(l);
+  }
+  return down;
+}
+
+// ---------------------- Convergence Probe ----------------------
+// Looks up a fixed set of destinations from every router and remembers the
+// chosen (gateway, interface); any difference between two samples counts as
+// a routing change.
+class RouteProbe {
+public:
+  RouteProbe(NodeContainer routers, std::vector<Ipv4Address> targets, Time interval, Time settle)
+      : m_routers(routers), m_targets(targets), m_interval(interval), m_settle(settle),
+        m_initialDone(false), m_changes(0) {}
+
+  void SetOnInitialConvergence(Callback<void> cb) { m_onInitial = cb; }
+  void SetExpected(std::vector<bool> expected) { m_expected = expected; }
+  void Start() { Simulator::Schedule(m_interval, &RouteProbe::Sample, this); }
+  void MarkFailure() { m_lastChange = Simulator::Now(); m_changes = 0; }
+
+  bool InitialDone() const { return m_initialDone; }
+  Time GetInitialConvergence() const { return m_initialConvergence; }
+  Time GetLastChange() const { return m_lastChange; }
+  uint32_t GetChanges() const { return m_changes; }
+  double GetWallMs() const { return m_wallMs; }
+
+  // Every lookup that should succeed does; lookups beyond reach are ignored
+  bool Complete() const {
+    if (m_state.empty())
+      return false;
+    for (uint32_t i = 0; i < m_state.size(); ++i)
+      if (m_expected[i] && m_state[i] == NO_ROUTE)
+        return false;
+    return true;
+  }
+
+private:
+  static constexpr uint64_t NO_ROUTE = UINT64_MAX;
+
+  void Sample() {
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<uint64_t> state;
+    state.reserve(m_routers.GetN() * m_targets.size());
+    for (uint32_t n = 0; n < m_routers.GetN(); ++n) {
+      Ptr<Ipv4RoutingProtocol> proto = m_routers.Get(n)->GetObject<Ipv4>()->GetRoutingProtocol();
+      for (const Ipv4Address &target : m_targets) {
+        Ipv4Header hdr;
+        hdr.SetDestination(target);
+        Socket::SocketErrno err;
+        Ptr<Ipv4Route> route = proto->RouteOutput(0, hdr, 0, err);
+        state.push_back(route ? (uint64_t(route->GetGateway().Get()) << 32) |
+                                    route->GetOutputDevice()->GetIfIndex()
+                              : NO_ROUTE);
+      }
+    }
+
+    Time now = Simulator::Now();
+    if (state != m_state) {
+      for (uint32_t i = 0; i < state.size(); ++i)
+        if (i >= m_state.size() || state[i] != m_state[i])
+          m_changes++;
+      m_state.swap(state);
+      m_lastChange = now;
+    }
+
+    if (!m_initialDone && Complete() && now - m_lastChange >= m_settle) {
+      m_initialDone = true;
+      m_initialConvergence = m_lastChange;
+      m_onInitial();
+    }
+    Simulator::Schedule(m_interval, &RouteProbe::Sample, this);
+    m_wallMs +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart)
+            .count();
+  }
+
+  NodeContainer m_routers;
+  std::vector<Ipv4Address> m_targets;
+  std::vector<bool> m_expected;
+  Time m_interval;
+  Time m_settle;
+  bool m_initialDone;
+  Time m_initialConvergence;
+  Time m_lastChange;
+  uint32_t m_changes;
+  double m_wallMs = 0;
+  std::vector<uint64_t> m_state;
+  Callback<void> m_onInitial;
+};
+
+// ---------------------- Scenario ----------------------
+struct DvRunConfig {
+  std::string topology = "grid";
+  uint32_t nRouters = 25;
+  double meshDegree = 3.0;
+  std::string routing = "rip";
+  uint32_t nFailures = 1;
+  uint32_t nTargets = 8;
+  double probeInterval = 0.5;
+  double settleTime = 15.0;
+  double preFailure = 5.0;
+  double ripUpdate = 30.0;
+  std::string dataRate = "10Mbps";
+  double linkDelayMs = 2.0;
+  uint32_t windowSize = 8;
+  double rtoMs = 0; // 0 = derived from the path length
+  double maxTime = 600.0;
+};
+
+struct DvRunResult {
+  uint32_t links = 0;
+  uint32_t diameter = 0;
+  uint32_t hops = 0;
+  uint32_t failed = 0;
+  bool initConverged = false;
+  bool reconverged = false;
+  double initConvS = 0;
+  double reconvS = 0;
+  uint32_t routeChanges = 0;
+  DvStats stats;
+  double recomputeWallMs = 0;
+  double probeWallMs = 0;
+  double wallMs = 0; // excluding probeWallMs
+};
+
+// Scenario state shared with the trace sinks and scheduled events
+struct DvScenario {
+  const MeshTopology *topo;
+  NodeContainer routers;
+  std::vector<std::pair<Ptr<NetDevice>, Ptr<NetDevice>>> linkDevices;
+  std::map<Ptr<NetDevice>, uint32_t> deviceLink;
+  std::vector<ProbeTarget> targets;
+  DvStats *stats;
+  RouteProbe *probe;
+  uint32_t src;
+  uint32_t dst;
+  Ipv4Address flowSrc;
+  Ipv4Address flowDst;
+  std::set<uint32_t> keep;
+  uint32_t nFailures;
+  uint32_t maxHops;
+  Time preFailure;
+  Time settle;
+  Time probeInterval;
+  uint32_t routedHops = 0;
+  std::set<uint32_t> failed;
+  double recomputeWallMs = 0;
+  bool reconverged = false;
+
+  // RIP sends after the failure; only those up to the last routing change
+  // count as reconvergence overhead, which is only known at the end
+  std::vector<Time> ctrlAfterFail;
+
+  void Tx(Ptr<const Packet> packet, Ptr<Ipv4>, uint32_t) {
+    Ptr<Packet> copy = packet->Copy();
+    Ipv4Header ipHdr;
+    copy->RemoveHeader(ipHdr);
+    if (ipHdr.GetProtocol() != UdpL4Protocol::PROT_NUMBER)
+      return;
+    UdpHeader udpHdr;
+    copy->PeekHeader(udpHdr);
+    if (udpHdr.GetDestinationPort() != RIP_PORT)
+      return;
+    stats->ctrlPackets++;
+    stats->ctrlBytes += packet->GetSize();
+    if (Simulator::Now() >= stats->failTime)
+      ctrlAfterFail.push_back(Simulator::Now());
+  }
+
+  void Drop(const Ipv4Header &hdr, Ptr<const Packet>, Ipv4L3Protocol::DropReason, Ptr<Ipv4>,
+            uint32_t) {
+    if (hdr.GetSource() == flowSrc && hdr.GetDestination() == flowDst &&
+        Simulator::Now() >= stats->failTime && !reconverged)
+      stats->dataDrops++;
+  }
+
+  // Links the flow is routed over right now, found by asking each router on
+  // the way for its route to flowDst
+  std::vector<uint32_t> RoutedPath() {
+    std::vector<uint32_t> path;
+    uint32_t node = src;
+    while (node != dst && path.size() < topo->nRouters) {
+      Ipv4Header hdr;
+      hdr.SetDestination(flowDst);
+      Socket::SocketErrno err;
+      Ptr<Ipv4Route> route =
+          routers.Get(node)->GetObject<Ipv4>()->GetRoutingProtocol()->RouteOutput(0, hdr, 0, err);
+      if (!route || !deviceLink.count(route->GetOutputDevice()))
+        break;
+      uint32_t link = deviceLink[route->GetOutputDevice()];
+      path.push_back(link);
+      node = OtherEnd(*topo, link, node);
+    }
+    return path;
+  }
+
+  void OnInitialConvergence() {
+    Simulator::Schedule(preFailure, &DvScenario::FailLinks, this);
+  }
+
+  void FailLinks() {
+    std::vector<uint32_t> path = RoutedPath();
+    routedHops = path.size();
+    failed = PickFailures(*topo, path, src, dst, nFailures, keep, RIP_MAX_HOPS);
+    NS_LOG_INFO("Failing " << failed.size() << " of " << path.size() << " routed link(s) at "
+                           << Simulator::Now().GetSeconds());
+
+    stats->failTime = Simulator::Now();
+    probe->MarkFailure();
+    probe->SetExpected(ExpectedRoutes(*topo, targets, failed, maxHops));
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t l : failed) {
+      for (Ptr<NetDevice> dev : {linkDevices[l].first, linkDevices[l].second}) {
+        Ptr<Ipv4> ipv4 = dev->GetNode()->GetObject<Ipv4>();
+        ipv4->SetDown(ipv4->GetInterfaceForDevice(dev));
+      }
+    }
+    recomputeWallMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    Simulator::Schedule(settle, &DvScenario::CheckReconvergence, this);
+  }
+
+  // Quiet for a whole settle window is not enough on its own: RIP neighbours
+  // with an alternative only advertise it on their next periodic update, so
+  // routes can stay missing without any change for a while. Keep waiting
+  // until everything reachable has a route again (maxTime still applies).
+  void CheckReconvergence() {
+    Time quiet = Simulator::Now() - probe->GetLastChange();
+    if (probe->Complete() && quiet >= settle) {
+      reconverged = true;
+      Simulator::Stop();
+      return;
+    }
+    Simulator::Schedule(quiet < settle ? settle - quiet : probeInterval,
+                        &DvScenario::CheckReconvergence, this);
+  }
+};
+
+static DvRunResult RunScenario(const DvRunConfig &cfg) {
+  auto wallStart = std::chrono::steady_clock::now();
+  DvRunResult result;
+
+  MeshTopology topo;
+  if (cfg.topology == "grid")
+    topo = BuildGrid(cfg.nRouters);
+  else if (cfg.topology == "random")
+    topo = BuildRandom(cfg.nRouters, cfg.meshDegree, cfg.nRouters);
+  else
+    NS_FATAL_ERROR("Unknown topology " << cfg.topology);
+  if (topo.nRouters < 2)
+    NS_FATAL_ERROR("Need at least two routers");
+
+  // Flow from router 0 to the farthest router RIP can still reach with two
+  // hops to spare for the detour, for both protocols so they carry the same
+  // flow
+  uint32_t src = 0;
+  uint32_t dst = FarthestRouter(topo, src, RIP_MAX_HOPS - 2);
+  std::vector<uint32_t> dist;
+  MeshBfs(topo, src, {}, dist);
+  uint32_t maxHops = cfg.routing == "rip" ? RIP_MAX_HOPS : UINT32_MAX - 1;
+
+  NodeContainer routers;
+  routers.Create(topo.nRouters);
+  InternetStackHelper stack;
+  stack.SetIpv6StackInstall(false);
+  if (cfg.routing == "rip") {
+    Config::SetDefault("ns3::Rip::UnsolicitedRoutingUpdate", TimeValue(Seconds(cfg.ripUpdate)));
+    RipHelper rip;
+    Ipv4ListRoutingHelper list;
+    list.Add(rip, 0);
+    stack.SetRoutingHelper(list);
+  } else if (cfg.routing == "global") {
+    Config::SetDefault("ns3::Ipv4GlobalRouting::RespondToInterfaceEvents", BooleanValue(true));
+  } else {
+    NS_FATAL_ERROR("Unknown routing " << cfg.routing);
+  }
+  stack.Install(routers);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute("DataRate", StringValue(cfg.dataRate));
+  p2p.SetChannelAttribute("Delay", TimeValue(Seconds(cfg.linkDelayMs / 1000)));
+
+  Ipv4AddressGenerator::Reset();
+  Ipv4AddressHelper address;
+  address.SetBase("10.0.0.0", "255.255.255.252");
+
+  DvStats stats;
+  DvScenario scenario;
+  scenario.topo = &topo;
+  scenario.routers = routers;
+  scenario.stats = &stats;
+  std::vector<std::pair<Ipv4Address, Ipv4Address>> linkAddr;
+  std::vector<uint32_t> firstLink(topo.nRouters, UINT32_MAX);
+  for (uint32_t i = 0; i < topo.links.size(); ++i) {
+    NetDeviceContainer devices =
+        p2p.Install(routers.Get(topo.links[i].first), routers.Get(topo.links[i].second));
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+    address.NewNetwork();
+    scenario.linkDevices.push_back({devices.Get(0), devices.Get(1)});
+    scenario.deviceLink[devices.Get(0)] = i;
+    scenario.deviceLink[devices.Get(1)] = i;
+    linkAddr.push_back({interfaces.GetAddress(0), interfaces.GetAddress(1)});
+    for (uint32_t r : {topo.links[i].first, topo.links[i].second})
+      if (firstLink[r] == UINT32_MAX)
+        firstLink[r] = i;
+  }
+  if (cfg.routing == "global")
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  // Every router is probed at its address on its first link
+  auto targetOf = [&](uint32_t r) {
+    uint32_t l = firstLink[r];
+    return ProbeTarget{topo.links[l].first == r ? linkAddr[l].first : linkAddr[l].second, l};
+  };
+
+  // Both ends bind to addresses on links that are kept up, so the connected
+  // sockets keep matching once traffic takes another way round
+  ProbeTarget srcTarget = targetOf(src);
+  ProbeTarget dstTarget = targetOf(dst);
+  scenario.src = src;
+  scenario.dst = dst;
+  scenario.flowSrc = srcTarget.address;
+  scenario.flowDst = dstTarget.address;
+  scenario.keep = {srcTarget.link, dstTarget.link};
+  scenario.nFailures = cfg.nFailures;
+  scenario.maxHops = maxHops;
+
+  scenario.targets = {dstTarget};
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
+  rand->SetStream(TARGET_STREAM_OFFSET + cfg.nRouters);
+  for (uint32_t attempts = 0;
+       scenario.targets.size() < cfg.nTargets && attempts < 10 * cfg.nTargets; ++attempts) {
+    ProbeTarget t = targetOf(rand->GetInteger(0, topo.nRouters - 1));
+    bool seen = false;
+    for (auto &existing : scenario.targets)
+      seen = seen || existing.address == t.address;
+    if (!seen)
+      scenario.targets.push_back(t);
+  }
+  std::vector<Ipv4Address> targetAddrs;
+  for (auto &t : scenario.targets)
+    targetAddrs.push_back(t.address);
+
+  // RIP's periodic updates come every ripUpdate plus up to half of it in
+  // jitter, so a shorter window can end between two rounds of updates
+  Time settle = Seconds(cfg.settleTime);
+  if (cfg.routing == "rip")
+    settle = std::max(settle, Seconds(1.5 * cfg.ripUpdate));
+
+  RouteProbe probe(routers, targetAddrs, Seconds(cfg.probeInterval), settle);
+  probe.SetExpected(ExpectedRoutes(topo, scenario.targets, {}, maxHops));
+  scenario.probe = &probe;
+  scenario.preFailure = Seconds(cfg.preFailure);
+  scenario.settle = settle;
+  scenario.probeInterval = Seconds(cfg.probeInterval);
+  probe.SetOnInitialConvergence(MakeCallback(&DvScenario::OnInitialConvergence, &scenario));
+  probe.Start();
+
+  Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/Tx",
+                                MakeCallback(&DvScenario::Tx, &scenario));
+  Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/Drop",
+                                MakeCallback(&DvScenario::Drop, &scenario));
+
+  // Go-Back-N flow, started right away and left to retry until routes exist
+  double rtoMs = cfg.rtoMs > 0 ? cfg.rtoMs : DefaultRtoMs(dist[dst], cfg.linkDelayMs);
+  TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+
+  Ptr<Socket> recvSocket = Socket::CreateSocket(routers.Get(dst), tid);
+  recvSocket->Bind(InetSocketAddress(scenario.flowDst, DATA_PORT));
+  recvSocket->Connect(InetSocketAddress(scenario.flowSrc, ACK_PORT));
+  Ptr<GoBackNReceiver> receiver = CreateObject<GoBackNReceiver>();
+  receiver->Setup(recvSocket, &stats);
+  routers.Get(dst)->AddApplication(receiver);
+  receiver->SetStartTime(Seconds(0.0));
+
+  Ptr<Socket> sendSocket = Socket::CreateSocket(routers.Get(src), tid);
+  sendSocket->Bind(InetSocketAddress(scenario.flowSrc, ACK_PORT));
+  Ptr<GoBackNSender> sender = CreateObject<GoBackNSender>();
+  sender->Setup(sendSocket, InetSocketAddress(scenario.flowDst, DATA_PORT), UINT32_MAX,
+                Seconds(rtoMs / 1000), cfg.windowSize, &stats);
+  routers.Get(src)->AddApplication(sender);
+  sender->SetStartTime(Seconds(1.0));
+
+  Simulator::Stop(Seconds(cfg.maxTime));
+  Simulator::Run();
+
+  // A flow that never recovers has no delivery to close its outage
+  if (stats.failTime != Time::Max())
+    stats.maxOutage =
+        std::max(stats.maxOutage, Simulator::Now() - std::max(stats.lastDelivery, stats.failTime));
+
+  result.links = topo.links.size();
+  result.hops = scenario.routedHops;
+  result.failed = scenario.failed.size();
+  result.initConverged = probe.InitialDone();
+  result.initConvS = probe.InitialDone() ? probe.GetInitialConvergence().GetSeconds() : 0;
+  result.reconverged = scenario.reconverged;
+  if (scenario.reconverged)
+    result.reconvS = (probe.GetLastChange() - stats.failTime).GetSeconds();
+  Time overheadEnd = scenario.reconverged ? probe.GetLastChange() : Simulator::Now();
+  stats.ctrlPacketsReconv = std::count_if(scenario.ctrlAfterFail.begin(),
+                                          scenario.ctrlAfterFail.end(),
+                                          [&](const Time &t) { return t <= overheadEnd; });
+  result.routeChanges = probe.GetChanges();
+  result.stats = stats;
+  result.recomputeWallMs = scenario.recomputeWallMs;
+  result.probeWallMs = probe.GetWallMs();
+
+  Simulator::Destroy();
+  result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                            wallStart)
+                      .count() -
+                  result.probeWallMs;
+  result.diameter = Diameter(topo);
+  return result;
+}
+
+static void PrintHeader() {
+  std::cout << "topology routers links diameter routing hops failed initConvS reconvS routeChanges "
+               "ctrlPkts ctrlBytes ctrlPktsReconv dataDrops outageS timeouts recomputeWallMs "
+               "wallMs probeWallMs"
+            << std::endl;
+}
+
+static void PrintResult(const DvRunConfig &cfg, const DvRunResult &r) {
+  std::cout << cfg.topology << " " << cfg.nRouters << " " << r.links << " " << r.diameter << " " << cfg.routing << " "
+            << r.hops << " " << r.failed << " "
+            << (r.initConverged ? std::to_string(r.initConvS) : "never") << " "
+            << (r.reconverged ? std::to_string(r.reconvS) : "never") << " " << r.routeChanges
+            << " " << r.stats.ctrlPackets << " " << r.stats.ctrlBytes << " "
+            << r.stats.ctrlPacketsReconv << " " << r.stats.dataDrops << " "
+            << r.stats.maxOutage.GetSeconds() << " " << r.stats.timeouts << " "
+            << r.recomputeWallMs << " " << r.wallMs << " " << r.probeWallMs << std::endl;
+}
+
+// ---------------------- Main ----------------------
+int main(int argc, char *argv[]) {
+  Time::SetResolution(Time::NS);
+
+  DvRunConfig cfg;
+  bool sweep = false;
+  bool verbose = false;
+  std::string sizeList = "9,25,49,100,225,400,1000";
+
+  CommandLine cmd;
+  cmd.AddValue("topology", "grid or random", cfg.topology);
+  cmd.AddValue("nRouters", "Number of routers", cfg.nRouters);
+  cmd.AddValue("meshDegree", "Average router degree for random meshes", cfg.meshDegree);
+  cmd.AddValue("routing", "rip or global", cfg.routing);
+  cmd.AddValue("nFailures", "Links on the flow's routed path taken down together", cfg.nFailures);
+  cmd.AddValue("nTargets", "Destinations looked up from every router per probe", cfg.nTargets);
+  cmd.AddValue("probeInterval", "Seconds between routing-state samples", cfg.probeInterval);
+  cmd.AddValue("settleTime",
+               "Seconds without routing changes that count as converged "
+               "(at least 1.5 x ripUpdate under RIP)",
+               cfg.settleTime);
+  cmd.AddValue("preFailure", "Seconds between initial convergence and the failure",
+               cfg.preFailure);
+  cmd.AddValue("ripUpdate", "RIP unsolicited update interval in seconds", cfg.ripUpdate);
+  cmd.AddValue("dataRate", "Link data rate", cfg.dataRate);
+  cmd.AddValue("linkDelayMs", "Link propagation delay in ms", cfg.linkDelayMs);
+  cmd.AddValue("window", "Go-Back-N window size", cfg.windowSize);
+  cmd.AddValue("rtoMs", "Retransmit timeout in ms (0 = scale with the flow's hop count)", cfg.rtoMs);
+  cmd.AddValue("maxTime", "Give up after this many simulated seconds", cfg.maxTime);
+  cmd.AddValue("sweep", "Run rip and global over sizeList", sweep);
+  cmd.AddValue("sizeList", "Router counts for --sweep", sizeList);
+  cmd.AddValue("verbose", "Log every packet", verbose);
+  cmd.Parse(argc, argv);
+
+  if (verbose)
+    LogComponentEnable("DvConvergenceExample", LOG_LEVEL_INFO);
+
+  PrintHeader();
+  if (!sweep) {
+    PrintResult(cfg, RunScenario(cfg));
+    return 0;
+  }
+
+  std::string item;
+  for (std::istringstream in(sizeList); std::getline(in, item, ',');) {
+    for (const char *routing : {"global", "rip"}) {
+      cfg.nRouters = std::stoul(item);
+      cfg.routing = routing;
+      PrintResult(cfg, RunScenario(cfg));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,169 @@
+/* mesh_topology.h
+   Router mesh builders shared by the multi-hop scratch programs
+   (multihop_arq.cc, dv_convergence.cc). Keep it next to them in ns-3/scratch/.
+*/
+
+#ifndef MESH_TOPOLOGY_H
+#define MESH_TOPOLOGY_H
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <vector>
+
+struct MeshTopology {
+  uint32_t nRouters = 0;
+  std::vector<std::pair<uint32_t, uint32_t>> links;
+  std::vector<std::pair<double, double>> positions; // NetAnim only
+};
+
+inline MeshTopology BuildGrid(uint32_t nRouters) {
+  MeshTopology topo;
+  topo.nRouters = nRouters;
+  uint32_t cols = std::ceil(std::sqrt(static_cast<double>(nRouters)));
+  for (uint32_t i = 0; i < nRouters; ++i) {
+    topo.positions.push_back({10.0 * (i % cols), 10.0 * (i / cols)});
+    if (i % cols != cols - 1 && i + 1 < nRouters)
+      topo.links.push_back({i, i + 1});
+    if (i + cols < nRouters)
+      topo.links.push_back({i, i + cols});
+  }
+  return topo;
+}
+
+// Random spanning tree first so the mesh is always connected, then extra
+// links until the requested average degree is reached. The RNG stream is
+// pinned by the caller: automatic streams keep counting across
+// Simulator::Destroy, so runs in one process would otherwise each get a
+// different mesh.
+inline MeshTopology BuildRandom(uint32_t nRouters, double degree, int64_t stream) {
+  MeshTopology topo;
+  topo.nRouters = nRouters;
+  ns3::Ptr<ns3::UniformRandomVariable> rand = ns3::CreateObject<ns3::UniformRandomVariable>();
+  rand->SetStream(stream);
+  std::set<std::pair<uint32_t, uint32_t>> used;
+
+  for (uint32_t i = 0; i < nRouters; ++i) {
+    topo.positions.push_back({rand->GetValue(0, 100), rand->GetValue(0, 100)});
+    if (i == 0)
+      continue;
+    uint32_t peer = rand->GetInteger(0, i - 1);
+    topo.links.push_back({peer, i});
+    used.insert({peer, i});
+  }
+
+  uint32_t target = static_cast<uint32_t>(nRouters * degree / 2);
+  uint32_t attempts = 0;
+  while (topo.links.size() < target && attempts++ < 20 * target) {
+    uint32_t a = rand->GetInteger(0, nRouters - 1);
+    uint32_t b = rand->GetInteger(0, nRouters - 1);
+    if (a == b)
+      continue;
+    if (a > b)
+      std::swap(a, b);
+    if (used.insert({a, b}).second)
+      topo.links.push_back({a, b});
+  }
+  return topo;
+}
+
+// One link per line: "<routerA> <routerB>", anything after the pair and lines
+// starting with '#' are comments (see link_state_routing.edges)
+inline MeshTopology LoadEdgeList(const std::string &fileName) {
+  std::ifstream in(fileName);
+  if (!in.is_open())
+    NS_FATAL_ERROR("Cannot open topology file " << fileName);
+
+  MeshTopology topo;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    uint32_t a, b;
+    if (!(fields >> a >> b) || a == b)
+      NS_FATAL_ERROR("Bad link line in " << fileName << ": " << line);
+    topo.links.push_back({a, b});
+    topo.nRouters = std::max(topo.nRouters, std::max(a, b) + 1);
+  }
+  for (uint32_t i = 0; i < topo.nRouters; ++i) {
+    double angle = 2 * M_PI * i / topo.nRouters;
+    topo.positions.push_back({50 + 40 * std::cos(angle), 50 + 40 * std::sin(angle)});
+  }
+  return topo;
+}
+
+inline uint32_t OtherEnd(const MeshTopology &topo, uint32_t link, uint32_t router) {
+  return topo.links[link].first == router ? topo.links[link].second : topo.links[link].first;
+}
+
+// BFS ignoring the links in `down`; returns the link each router was reached
+// over (UINT32_MAX for src and unreachable routers) and fills in hop distances.
+inline std::vector<uint32_t> MeshBfs(const MeshTopology &topo, uint32_t src,
+                                     const std::set<uint32_t> &down,
+                                     std::vector<uint32_t> &dist) {
+  std::vector<std::vector<uint32_t>> adj(topo.nRouters);
+  for (uint32_t i = 0; i < topo.links.size(); ++i) {
+    if (down.count(i))
+      continue;
+    adj[topo.links[i].first].push_back(i);
+    adj[topo.links[i].second].push_back(i);
+  }
+  std::vector<uint32_t> parentLink(topo.nRouters, UINT32_MAX);
+  dist.assign(topo.nRouters, UINT32_MAX);
+  std::queue<uint32_t> todo;
+  dist[src] = 0;
+  todo.push(src);
+  while (!todo.empty()) {
+    uint32_t u = todo.front();
+    todo.pop();
+    for (uint32_t l : adj[u]) {
+      uint32_t v = OtherEnd(topo, l, u);
+      if (dist[v] == UINT32_MAX) {
+        dist[v] = dist[u] + 1;
+        parentLink[v] = l;
+        todo.push(v);
+      }
+    }
+  }
+  return parentLink;
+}
+
+// Routers on a shortest src->dst path, src first
+inline std::vector<uint32_t> ShortestPath(const MeshTopology &topo, uint32_t src, uint32_t dst) {
+  std::vector<uint32_t> dist;
+  std::vector<uint32_t> parentLink = MeshBfs(topo, src, {}, dist);
+  if (dist[dst] == UINT32_MAX)
+    NS_FATAL_ERROR("Router " << dst << " is not reachable from " << src);
+  std::vector<uint32_t> path;
+  for (uint32_t v = dst; v != src; v = OtherEnd(topo, parentLink[v], v))
+    path.push_back(v);
+  path.push_back(src);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+// Farthest router from src that is at most maxHops away
+inline uint32_t FarthestRouter(const MeshTopology &topo, uint32_t src,
+                               uint32_t maxHops = UINT32_MAX - 1) {
+  std::vector<uint32_t> dist;
+  MeshBfs(topo, src, {}, dist);
+  uint32_t best = src;
+  for (uint32_t i = 0; i < topo.nRouters; ++i)
+    if (dist[i] <= maxHops && dist[i] > dist[best])
+      best = i;
+  return best;
+}
+
+// Go-Back-N retransmit timeout for a session spanning `hops` links: a fixed
+// allowance for queueing plus a couple of round trips of propagation delay.
+inline double DefaultRtoMs(uint32_t hops, double linkDelayMs) {
+  return 100 + 4 * hops * linkDelayMs;
+}
+
+#endif /* MESH_TOPOLOGY_H */
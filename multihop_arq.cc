@@ -0,0 +1,502 @@
+/* multihop_arq.cc
+   Hop-by-hop vs end-to-end Go-Back-N ARQ over multi-hop router meshes (ns-3)
+
+   The router mesh is either generated (grid / random) or loaded from a plain
+   edge list, and routed with Ipv4GlobalRoutingHelper (link state). The .pkt
+   files are Packet Tracer archives ns-3 cannot read, so their layouts are
+   transcribed next to them as link_state_routing.edges and
+   vecctor_routing.edges (one "<nodeA> <nodeB>" link per line, switches and
+   PCs included as nodes). Grid and random meshes scale that shape up.
+
+   Modes:
+     e2e  - one ARQ session between the two end routers, routed across the mesh
+     hop  - one ARQ session per link on the path, every router in between
+            relays in-order packets to the next hop
+
+   Compile: put it, mesh_topology.h and the .edges files in ns-3/scratch/
+   and run, e.g.
+     ./ns3 run "scratch/multihop_arq --topology=file --topologyFile=scratch/link_state_routing.edges --mode=e2e"
+     ./ns3 run "scratch/multihop_arq --topology=grid --nRouters=100 --mode=hop --loss=0.01"
+     ./ns3 run "scratch/multihop_arq --sweep=true --lossList=0,0.01,0.05"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/netanim-module.h"
+#include "ns3/seq-ts-header.h"
+
+#include "mesh_topology.h"
+
+#include <chrono>
+#include <sstream>
+
+using namespace ns3;
+NS_LOG_COMPONENT_DEFINE("MultiHopArqExample");
+
+static const uint16_t ARQ_PORT = 8080;
+
+// ---------------------- Sender Application ----------------------
+// Go-Back-N over a growing buffer: the source fills it from a traffic
+// generator, a relay fills it with whatever its upstream receiver delivers.
+class ArqSender : public Application {
+public:
+  ArqSender();
+  virtual ~ArqSender();
+  void Setup(Ptr<Socket> socket, Address peer, Time timeout, uint32_t windowSize);
+  void Enqueue(Ptr<Packet> packet);
+  uint32_t GetRetransmissions() const { return m_retransmissions; }
+
+private:
+  virtual void StartApplication();
+  virtual void StopApplication();
+  void SendWindow();
+  void SendPacket(uint32_t seq);
+  void Timeout();
+  void HandleAck(Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;
+  Address m_peer;
+  Time m_timeout;
+  uint32_t m_windowSize;
+  uint32_t m_base;
+  uint32_t m_nextSeq;
+  uint32_t m_highestSent;
+  uint32_t m_retransmissions;
+  bool m_running;
+  EventId m_timeoutEvent;
+  std::vector<Ptr<Packet>> m_buffer;
+};
+
+ArqSender::ArqSender()
+    : m_socket(0), m_windowSize(0), m_base(0), m_nextSeq(0), m_highestSent(0),
+      m_retransmissions(0), m_running(false) {}
+
+ArqSender::~ArqSender() { m_socket = 0; }
+
+void ArqSender::Setup(Ptr<Socket> socket, Address peer, Time timeout, uint32_t windowSize) {
+  m_socket = socket;
+  m_peer = peer;
+  m_timeout = timeout;
+  m_windowSize = windowSize;
+}
+
+void ArqSender::Enqueue(Ptr<Packet> packet) {
+  m_buffer.push_back(packet);
+  if (m_running)
+    SendWindow();
+}
+
+void ArqSender::StartApplication() {
+  m_running = true;
+  m_socket->Connect(m_peer);
+  m_socket->SetRecvCallback(MakeCallback(&ArqSender::HandleAck, this));
+  SendWindow();
+}
+
+void ArqSender::StopApplication() {
+  m_running = false;
+  Simulator::Cancel(m_timeoutEvent);
+  if (m_socket)
+    m_socket->Close();
+}
+
+void ArqSender::SendWindow() {
+  while (m_nextSeq < m_base + m_windowSize && m_nextSeq < m_buffer.size()) {
+    SendPacket(m_nextSeq);
+    m_nextSeq++;
+  }
+  if (m_base < m_nextSeq && !m_timeoutEvent.IsRunning())
+    m_timeoutEvent = Simulator::Schedule(m_timeout, &ArqSender::Timeout, this);
+}
+
+void ArqSender::SendPacket(uint32_t seq) {
+  // The per-link header goes on top of the end-to-end one, which is what
+  // carries the original timestamp through the relays.
+  Ptr<Packet> pkt = m_buffer[seq]->Copy();
+  SeqTsHeader hdr;
+  hdr.SetSeq(seq);
+  pkt->AddHeader(hdr);
+  m_socket->Send(pkt);
+
+  if (seq < m_highestSent)
+    m_retransmissions++;
+  else
+    m_highestSent = seq + 1;
+  NS_LOG_INFO("Node " << GetNode()->GetId() << ": Sent packet " << seq);
+}
+
+void ArqSender::Timeout() {
+  NS_LOG_INFO("Node " << GetNode()->GetId() << ": Timeout! Resending window from " << m_base);
+  m_nextSeq = m_base;
+  SendWindow();
+}
+
+void ArqSender::HandleAck(Ptr<Socket> socket) {
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv())) {
+    SeqTsHeader hdr;
+    packet->RemoveHeader(hdr);
+    // Cumulative ACK: everything below this sequence number has arrived
+    uint32_t ack = hdr.GetSeq();
+    if (ack <= m_base)
+      continue;
+
+    for (uint32_t i = m_base; i < ack; ++i)
+      m_buffer[i] = 0;
+    m_base = ack;
+    if (m_nextSeq < m_base)
+      m_nextSeq = m_base;
+    Simulator::Cancel(m_timeoutEvent);
+    SendWindow();
+  }
+}
+
+// ---------------------- Receiver Application ----------------------
+class ArqReceiver : public Application {
+public:
+  ArqReceiver();
+  virtual ~ArqReceiver();
+  void Setup(Ptr<Socket> socket, Callback<void, Ptr<Packet>> deliver);
+
+private:
+  virtual void StartApplication();
+  virtual void StopApplication();
+  void HandleRead(Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;
+  Callback<void, Ptr<Packet>> m_deliver;
+  uint32_t m_expected;
+};
+
+ArqReceiver::ArqReceiver() : m_socket(0), m_expected(0) {}
+
+ArqReceiver::~ArqReceiver() { m_socket = 0; }
+
+void ArqReceiver::Setup(Ptr<Socket> socket, Callback<void, Ptr<Packet>> deliver) {
+  m_socket = socket;
+  m_deliver = deliver;
+}
+
+void ArqReceiver::StartApplication() {
+  m_socket->SetRecvCallback(MakeCallback(&ArqReceiver::HandleRead, this));
+}
+
+void ArqReceiver::StopApplication() {
+  if (m_socket)
+    m_socket->Close();
+}
+
+void ArqReceiver::HandleRead(Ptr<Socket> socket) {
+  Ptr<Packet> pkt;
+  Address from;
+  while ((pkt = socket->RecvFrom(from))) {
+    SeqTsHeader hdr;
+    pkt->RemoveHeader(hdr);
+    uint32_t seq = hdr.GetSeq();
+
+    if (seq == m_expected) {
+      NS_LOG_INFO("Node " << GetNode()->GetId() << ": Got packet " << seq);
+      m_expected++;
+      m_deliver(pkt);
+    } else {
+      NS_LOG_INFO("Node " << GetNode()->GetId() << ": Got out-of-order packet " << seq
+                          << " (expected " << m_expected << ")");
+    }
+
+    Ptr<Packet> ack = Create<Packet>();
+    SeqTsHeader ackHdr;
+    ackHdr.SetSeq(m_expected);
+    ack->AddHeader(ackHdr);
+    socket->SendTo(ack, 0, from);
+  }
+}
+
+// ---------------------- Statistics ----------------------
+struct FlowStats {
+  uint32_t delivered = 0;
+  uint64_t bytes = 0;
+  Time latencySum;
+  Time latencyMax;
+  Time lastDelivery;
+
+  void Deliver(Ptr<Packet> packet) {
+    SeqTsHeader inner;
+    packet->RemoveHeader(inner);
+    Time latency = Simulator::Now() - inner.GetTs();
+    delivered++;
+    bytes += packet->GetSize();
+    latencySum += latency;
+    latencyMax = std::max(latencyMax, latency);
+    lastDelivery = Simulator::Now();
+  }
+};
+
+struct ArqRunConfig {
+  std::string topology = "grid";
+  std::string topologyFile;
+  uint32_t nRouters = 25;
+  double meshDegree = 3.0;
+  uint32_t src = 0;
+  int64_t dst = -1; // -1 = farthest router from src
+  std::string mode = "hop";
+  double loss = 0.0;
+  std::string dataRate = "10Mbps";
+  double linkDelayMs = 2.0;
+  uint32_t packetSize = 512;
+  uint32_t nPackets = 200;
+  double intervalMs = 5.0;
+  uint32_t windowSize = 8;
+  double rtoMs = 0; // 0 = derived from the hop count the ARQ spans
+  double simTime = 120.0;
+  bool anim = false;
+};
+
+struct ArqRunResult {
+  uint32_t routers = 0;
+  uint32_t links = 0;
+  uint32_t hops = 0;
+  uint32_t delivered = 0;
+  double meanLatencyMs = 0;
+  double maxLatencyMs = 0;
+  double throughputKbps = 0;
+  uint32_t retransmissions = 0;
+  double setupWallMs = 0;
+  double runWallMs = 0;
+};
+
+static void GenerateTraffic(Ptr<ArqSender> sender, uint32_t packetSize, uint32_t seq,
+                            uint32_t total, Time interval) {
+  if (seq >= total)
+    return;
+  Ptr<Packet> pkt = Create<Packet>(packetSize);
+  SeqTsHeader inner; // timestamped now, read back at the far end
+  inner.SetSeq(seq);
+  pkt->AddHeader(inner);
+  sender->Enqueue(pkt);
+  Simulator::Schedule(interval, &GenerateTraffic, sender, packetSize, seq + 1, total, interval);
+}
+
+// ---------------------- Scenario ----------------------
+static ArqRunResult RunScenario(const ArqRunConfig &cfg) {
+  using Clock = std::chrono::steady_clock;
+  auto wallStart = Clock::now();
+
+  MeshTopology topo;
+  if (cfg.topology == "grid")
+    topo = BuildGrid(cfg.nRouters);
+  else if (cfg.topology == "random")
+    topo = BuildRandom(cfg.nRouters, cfg.meshDegree, cfg.nRouters);
+  else if (cfg.topology == "file")
+    topo = LoadEdgeList(cfg.topologyFile);
+  else
+    NS_FATAL_ERROR("Unknown topology " << cfg.topology);
+  if (cfg.mode != "e2e" && cfg.mode != "hop")
+    NS_FATAL_ERROR("Unknown mode " << cfg.mode);
+
+  if (cfg.src >= topo.nRouters || cfg.dst >= static_cast<int64_t>(topo.nRouters))
+    NS_FATAL_ERROR("src/dst must be below the " << topo.nRouters << " routers in the mesh");
+
+  uint32_t dst = cfg.dst < 0 ? FarthestRouter(topo, cfg.src) : static_cast<uint32_t>(cfg.dst);
+  std::vector<uint32_t> path = ShortestPath(topo, cfg.src, dst);
+  if (path.size() < 2)
+    NS_FATAL_ERROR("Source and destination must be different routers");
+
+  NodeContainer routers;
+  routers.Create(topo.nRouters);
+  InternetStackHelper stack;
+  stack.Install(routers);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute("DataRate", StringValue(cfg.dataRate));
+  p2p.SetChannelAttribute("Delay", TimeValue(Seconds(cfg.linkDelayMs / 1000)));
+
+  Ipv4AddressGenerator::Reset();
+  Ipv4AddressHelper address;
+  address.SetBase("10.0.0.0", "255.255.255.252");
+
+  std::map<std::pair<uint32_t, uint32_t>, Ipv4Address> neighbourAddr;
+  for (auto &l : topo.links) {
+    NetDeviceContainer devices = p2p.Install(routers.Get(l.first), routers.Get(l.second));
+    for (uint32_t d = 0; d < devices.GetN(); ++d) {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel>();
+      em->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+      em->SetAttribute("ErrorRate", DoubleValue(cfg.loss));
+      devices.Get(d)->SetAttribute("ReceiveErrorModel", PointerValue(em));
+    }
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+    address.NewNetwork();
+    neighbourAddr[{l.first, l.second}] = interfaces.GetAddress(1);
+    neighbourAddr[{l.second, l.first}] = interfaces.GetAddress(0);
+  }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  // One ARQ session per (from, to) pair: the whole path for e2e, every link
+  // on it for hop-by-hop.
+  std::vector<std::pair<uint32_t, uint32_t>> sessions;
+  if (cfg.mode == "e2e")
+    sessions.push_back({path.front(), path.back()});
+  else
+    for (uint32_t i = 0; i + 1 < path.size(); ++i)
+      sessions.push_back({path[i], path[i + 1]});
+
+  uint32_t hopsPerSession = cfg.mode == "e2e" ? path.size() - 1 : 1;
+  double rtoMs = cfg.rtoMs > 0 ? cfg.rtoMs : DefaultRtoMs(hopsPerSession, cfg.linkDelayMs);
+  Time rto = Seconds(rtoMs / 1000);
+
+  FlowStats stats;
+  TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+  std::vector<Ptr<ArqSender>> senders(sessions.size());
+  std::vector<Ipv4Address> peers(sessions.size());
+  for (uint32_t s = 0; s < sessions.size(); ++s) {
+    Ptr<Node> from = routers.Get(sessions[s].first);
+    Ptr<Node> to = routers.Get(sessions[s].second);
+    peers[s] = cfg.mode == "e2e" ? to->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal()
+                                 : neighbourAddr[sessions[s]];
+
+    Ptr<Socket> sendSocket = Socket::CreateSocket(from, tid);
+    sendSocket->Bind();
+    senders[s] = CreateObject<ArqSender>();
+    senders[s]->Setup(sendSocket, InetSocketAddress(peers[s], ARQ_PORT), rto, cfg.windowSize);
+    from->AddApplication(senders[s]);
+    senders[s]->SetStartTime(Seconds(1.0));
+    senders[s]->SetStopTime(Seconds(cfg.simTime));
+  }
+  for (uint32_t s = 0; s < sessions.size(); ++s) {
+    Ptr<Node> to = routers.Get(sessions[s].second);
+    // Bound to the address the sender targets, so ACKs leave from the
+    // address its connected socket expects whatever interface they route out of
+    Ptr<Socket> recvSocket = Socket::CreateSocket(to, tid);
+    recvSocket->Bind(InetSocketAddress(peers[s], ARQ_PORT));
+
+    // A relay hands every in-order packet straight to the next hop's sender
+    Callback<void, Ptr<Packet>> deliver =
+        s + 1 < sessions.size() ? MakeCallback(&ArqSender::Enqueue, senders[s + 1])
+                                : MakeCallback(&FlowStats::Deliver, &stats);
+    Ptr<ArqReceiver> receiver = CreateObject<ArqReceiver>();
+    receiver->Setup(recvSocket, deliver);
+    to->AddApplication(receiver);
+    receiver->SetStartTime(Seconds(0.0));
+    receiver->SetStopTime(Seconds(cfg.simTime));
+  }
+  Simulator::Schedule(Seconds(1.0), &GenerateTraffic, senders.front(), cfg.packetSize, 0,
+                      cfg.nPackets, Seconds(cfg.intervalMs / 1000));
+
+  AnimationInterface *anim = 0;
+  if (cfg.anim) {
+    anim = new AnimationInterface("multihop-arq.xml");
+    for (uint32_t i = 0; i < topo.nRouters; ++i)
+      anim->SetConstantPosition(routers.Get(i), topo.positions[i].first, topo.positions[i].second);
+    anim->UpdateNodeDescription(routers.Get(path.front()), "Sender");
+    anim->UpdateNodeDescription(routers.Get(path.back()), "Receiver");
+  }
+
+  auto runStart = Clock::now();
+  Simulator::Stop(Seconds(cfg.simTime));
+  Simulator::Run();
+  auto runEnd = Clock::now();
+
+  ArqRunResult result;
+  result.routers = topo.nRouters;
+  result.links = topo.links.size();
+  result.hops = path.size() - 1;
+  result.delivered = stats.delivered;
+  if (stats.delivered > 0) {
+    result.meanLatencyMs = stats.latencySum.GetSeconds() * 1000 / stats.delivered;
+    result.maxLatencyMs = stats.latencyMax.GetSeconds() * 1000;
+    double active = (stats.lastDelivery - Seconds(1.0)).GetSeconds();
+    result.throughputKbps = active > 0 ? stats.bytes * 8 / active / 1000 : 0;
+  }
+  for (auto &s : senders)
+    result.retransmissions += s->GetRetransmissions();
+  result.setupWallMs = std::chrono::duration<double, std::milli>(runStart - wallStart).count();
+  result.runWallMs = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+
+  Simulator::Destroy();
+  delete anim;
+  return result;
+}
+
+static void PrintHeader() {
+  std::cout << "topology routers links mode hops loss delivered meanLatMs maxLatMs "
+               "tputKbps retx setupWallMs runWallMs"
+            << std::endl;
+}
+
+static void PrintResult(const ArqRunConfig &cfg, const ArqRunResult &r) {
+  std::cout << cfg.topology << " " << r.routers << " " << r.links << " " << cfg.mode << " "
+            << r.hops << " " << cfg.loss << " " << r.delivered << "/" << cfg.nPackets << " "
+            << r.meanLatencyMs << " " << r.maxLatencyMs << " " << r.throughputKbps << " "
+            << r.retransmissions << " " << r.setupWallMs << " " << r.runWallMs << std::endl;
+}
+
+// ---------------------- Main ----------------------
+int main(int argc, char *argv[]) {
+  Time::SetResolution(Time::NS);
+
+  ArqRunConfig cfg;
+  bool sweep = false;
+  bool verbose = false;
+  std::string sizeList = "10,30,100,300,1000";
+  std::string lossList = "0,0.01,0.05";
+
+  CommandLine cmd;
+  cmd.AddValue("topology", "grid, random or file", cfg.topology);
+  cmd.AddValue("topologyFile", "Edge list used with --topology=file", cfg.topologyFile);
+  cmd.AddValue("nRouters", "Number of routers for generated meshes", cfg.nRouters);
+  cmd.AddValue("meshDegree", "Average router degree for random meshes", cfg.meshDegree);
+  cmd.AddValue("src", "Source router", cfg.src);
+  cmd.AddValue("dst", "Destination router (-1 = farthest from src)", cfg.dst);
+  cmd.AddValue("mode", "e2e or hop", cfg.mode);
+  cmd.AddValue("loss", "Per-link packet loss rate", cfg.loss);
+  cmd.AddValue("dataRate", "Link data rate", cfg.dataRate);
+  cmd.AddValue("linkDelayMs", "Link propagation delay in ms", cfg.linkDelayMs);
+  cmd.AddValue("packetSize", "Payload bytes per packet", cfg.packetSize);
+  cmd.AddValue("nPackets", "Total data packets to send", cfg.nPackets);
+  cmd.AddValue("intervalMs", "Gap between packets offered by the source in ms", cfg.intervalMs);
+  cmd.AddValue("window", "Go-Back-N window size", cfg.windowSize);
+  cmd.AddValue("rtoMs", "Retransmit timeout in ms (0 = scale with the hops one session spans)", cfg.rtoMs);
+  cmd.AddValue("simTime", "Simulation stop time in seconds", cfg.simTime);
+  cmd.AddValue("anim", "Write multihop-arq.xml for NetAnim", cfg.anim);
+  cmd.AddValue("sweep", "Run both modes over sizeList x lossList", sweep);
+  cmd.AddValue("sizeList", "Router counts for --sweep", sizeList);
+  cmd.AddValue("lossList", "Per-link loss rates for --sweep", lossList);
+  cmd.AddValue("verbose", "Log every packet", verbose);
+  cmd.Parse(argc, argv);
+
+  if (verbose)
+    LogComponentEnable("MultiHopArqExample", LOG_LEVEL_INFO);
+
+  PrintHeader();
+  if (!sweep) {
+    ArqRunResult r = RunScenario(cfg);
+    PrintResult(cfg, r);
+    return 0;
+  }
+
+  if (cfg.topology == "file")
+    NS_FATAL_ERROR("--sweep varies the router count and cannot be used with --topology=file");
+
+  std::vector<uint32_t> sizes;
+  std::vector<double> losses;
+  std::string item;
+  for (std::istringstream in(sizeList); std::getline(in, item, ',');)
+    sizes.push_back(std::stoul(item));
+  for (std::istringstream in(lossList); std::getline(in, item, ',');)
+    losses.push_back(std::stod(item));
+
+  cfg.anim = false;
+  for (uint32_t n : sizes) {
+    for (double loss : losses) {
+      for (const char *mode : {"e2e", "hop"}) {
+        cfg.nRouters = n;
+        cfg.loss = loss;
+        cfg.mode = mode;
+        PrintResult(cfg, RunScenario(cfg));
+      }
+    }
+  }
+  return 0;
+}